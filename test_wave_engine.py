@@ -0,0 +1,213 @@
+# Regression checks for wave_engine.cpp. Build the module (see its header),
+# then run: python3 test_wave_engine.py
+import _thread
+import ctypes
+import math
+import threading
+import time
+
+import numpy as np
+import wave_engine
+
+
+def reference_steps(u_curr, u_prev, c, dt, dx, steps):
+    # Vectorised form of the update loop in 2d_Wave.ipynb
+    r2 = (c*dt/dx)**2
+    for _ in range(steps):
+        u_next = np.zeros_like(u_curr)
+        u_next[1:-1, 1:-1] = 2*u_curr[1:-1, 1:-1] - u_prev[1:-1, 1:-1] + r2 * (
+            u_curr[2:, 1:-1] + u_curr[:-2, 1:-1] +
+            u_curr[1:-1, 2:] + u_curr[1:-1, :-2] -
+            4*u_curr[1:-1, 1:-1])
+        u_prev, u_curr = u_curr, u_next
+    return u_curr
+
+
+def gaussian_pulse(nx, ny, dx, sigma=0.20):
+    x = np.linspace(0, nx*dx, nx)
+    y = np.linspace(0, ny*dx, ny)
+    X, Y = np.meshgrid(x, y)
+    x0, y0 = nx//2*dx, ny//2*dx
+    return np.exp(-((X-x0)**2 + (Y-y0)**2)/(2*sigma**2))
+
+
+def start_stepping(engine, steps):
+    # Returns once the worker thread is inside step() with the GIL released
+    worker = threading.Thread(target=engine.step, args=(steps,))
+    worker.start()
+    while worker.is_alive():
+        try:
+            engine.steps
+        except RuntimeError:
+            return worker
+    raise AssertionError("step() finished before it could be observed")
+
+
+def test_matches_notebook():
+    nx, ny, dx, c, dt = 50, 50, 0.2, 1.0, 0.05
+    u0 = gaussian_pulse(nx, ny, dx)
+    engine = wave_engine.Engine(u0, c=c, dt=dt, dx=dx)
+    engine.step(37)
+    expected = reference_steps(u0, np.zeros_like(u0), c, dt, dx, 37)
+    assert engine.steps == 37
+    assert engine.shape == (nx, ny)
+    assert np.abs(np.asarray(engine.current) - expected).max() < 1e-12
+
+
+def test_views_are_zero_copy():
+    u0 = gaussian_pulse(20, 30, 0.2)
+    engine = wave_engine.Engine(u0)
+    a = np.asarray(engine.current)
+    b = np.asarray(engine.current)
+    assert a.shape == u0.shape and a.dtype == np.float64
+    assert np.shares_memory(a, b)
+    a[5, 7] = 42.0
+    assert np.asarray(engine.current)[5, 7] == 42.0
+
+    # Views keep the engine's memory alive
+    del engine, b
+    assert a[5, 7] == 42.0
+
+
+def test_views_follow_latest_step():
+    u0 = gaussian_pulse(50, 50, 0.2)
+    engine = wave_engine.Engine(u0)
+    curr = np.asarray(engine.current)
+    prev = np.asarray(engine.previous)
+    engine.step(1)
+    engine.step(2)
+    assert np.shares_memory(curr, np.asarray(engine.current))
+    assert np.abs(curr - reference_steps(u0, np.zeros_like(u0), 1.0, 0.05, 0.2, 3)).max() < 1e-12
+    assert np.abs(prev - reference_steps(u0, np.zeros_like(u0), 1.0, 0.05, 0.2, 2)).max() < 1e-12
+
+
+def test_reinit_refused_while_field_alive():
+    engine = wave_engine.Engine(np.ones((2000, 2000)))
+    field = engine.current.obj
+    try:
+        engine.__init__(np.ones((3, 3)))
+    except BufferError:
+        pass
+    else:
+        raise AssertionError("re-init with a live Field should be refused")
+    a = np.asarray(memoryview(field))
+    a[:] = 7
+    assert engine.shape == (2000, 2000)
+    assert np.asarray(engine.current)[1000, 1000] == 7
+
+    del a, field
+    engine.__init__(np.ones((3, 3)))
+    assert np.asarray(engine.current).shape == (3, 3)
+
+
+def test_simple_buffer_request():
+    class Py_buffer(ctypes.Structure):
+        _fields_ = [("buf", ctypes.c_void_p), ("obj", ctypes.py_object),
+                    ("len", ctypes.c_ssize_t), ("itemsize", ctypes.c_ssize_t),
+                    ("readonly", ctypes.c_int), ("ndim", ctypes.c_int),
+                    ("format", ctypes.c_char_p), ("shape", ctypes.c_void_p),
+                    ("strides", ctypes.c_void_p), ("suboffsets", ctypes.c_void_p),
+                    ("internal", ctypes.c_void_p)]
+
+    engine = wave_engine.Engine(np.zeros((4, 6)))
+    field = engine.current.obj
+    view = Py_buffer()
+    ctypes.pythonapi.PyObject_GetBuffer.argtypes = [ctypes.py_object, ctypes.POINTER(Py_buffer), ctypes.c_int]
+    assert ctypes.pythonapi.PyObject_GetBuffer(field, ctypes.byref(view), 0) == 0  # PyBUF_SIMPLE
+    try:
+        assert view.len == 4*6*8
+        assert view.shape is None and view.strides is None
+    finally:
+        ctypes.pythonapi.PyBuffer_Release(ctypes.byref(view))
+
+    try:
+        ctypes.pythonapi.PyObject_GetBuffer(field, ctypes.byref(view), 0x58)  # PyBUF_F_CONTIGUOUS
+    except BufferError:
+        pass
+    else:
+        ctypes.pythonapi.PyBuffer_Release(ctypes.byref(view))
+        raise AssertionError("Fortran-order request should be rejected")
+
+
+def test_gil_released_during_step():
+    # If step() held the GIL, start_stepping() could not observe it running,
+    # and none of the work below could finish before the worker does.
+    engine = wave_engine.Engine(np.zeros((2048, 2048)))
+    worker = start_stepping(engine, 200)
+    for _ in range(20):
+        time.sleep(0)
+    total = sum(range(100000))
+    still_stepping = worker.is_alive()
+    worker.join()
+    assert total == 4999950000
+    assert still_stepping, "main thread made no progress while step() was running"
+    assert engine.steps == 200
+
+
+def test_step_is_interruptible():
+    u0 = gaussian_pulse(64, 64, 0.2)
+    engine = wave_engine.Engine(u0)
+    view = np.asarray(engine.current)
+    timer = threading.Timer(0.2, _thread.interrupt_main)
+    timer.start()
+    try:
+        engine.step(10**12)
+    except KeyboardInterrupt:
+        pass
+    else:
+        raise AssertionError("step() ignored the interrupt")
+    finally:
+        timer.cancel()
+
+    # A partial run is consistent: `steps` matches the state it left behind
+    taken = engine.steps
+    assert 0 < taken < 10**12
+    replay = wave_engine.Engine(u0)
+    replay.step(taken)
+    assert np.array_equal(view, np.asarray(replay.current))
+
+
+def test_rejects_access_while_stepping():
+    engine = wave_engine.Engine(np.zeros((2048, 2048)))
+    worker = start_stepping(engine, 200)
+    for attempt in (lambda: engine.__init__(np.random.rand(3, 3)),
+                    lambda: engine.current,
+                    lambda: engine.previous,
+                    lambda: engine.step(1),
+                    lambda: setattr(engine, "dt", 0.01)):
+        try:
+            attempt()
+        except RuntimeError:
+            pass
+        else:
+            raise AssertionError("expected RuntimeError while stepping")
+    assert worker.is_alive(), "step() finished too early for the checks to be meaningful"
+    worker.join()
+    assert engine.steps == 200 and engine.shape == (2048, 2048)
+
+
+def test_parameter_validation():
+    engine = wave_engine.Engine(np.zeros((8, 8)))
+    for name, value in (("dt", -1.0), ("c", 0.0), ("dx", math.inf), ("damping", math.nan), ("damping", -0.5)):
+        try:
+            setattr(engine, name, value)
+        except ValueError as e:
+            assert str(e).startswith(name), e
+        else:
+            raise AssertionError(f"{name}={value} was accepted")
+        try:
+            wave_engine.Engine(np.zeros((8, 8)), **{name: value})
+        except ValueError as e:
+            assert str(e).startswith(name), e
+        else:
+            raise AssertionError(f"Engine({name}={value}) was accepted")
+    engine.damping = 0.999
+    assert engine.damping == 0.999
+
+
+if __name__ == "__main__":
+    for name, test in list(globals().items()):
+        if name.startswith("test_"):
+            start = time.time()
+            test()
+            print(f"{name}: ok ({time.time() - start:.2f}s)")
@@ -0,0 +1,518 @@
+// CPU wave engine exposed as a Python extension module.
+//
+// Runs the same leapfrog scheme as 2d_Wave.ipynb, but in C++ and with the
+// GIL released while stepping. State buffers are handed to Python through
+// the buffer protocol, so np.asarray(engine.current) is a view, not a copy.
+// The current/previous buffers keep their addresses across steps, so such a
+// view always shows the latest time level.
+//
+// Build (from the repo root):
+//   g++ -O3 -march=native -fopenmp -shared -fPIC $(python3-config --includes)
+//       wave_engine.cpp -o wave_engine$(python3-config --extension-suffix)
+//
+// Usage:
+//   import numpy as np, wave_engine
+//   eng = wave_engine.Engine(u0, c=1.0, dt=0.05, dx=0.2)
+//   eng.step(100)
+//   u = np.asarray(eng.current)
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <new>
+
+// Solver state. buffers[0] holds u(t-dt) and buffers[1] holds u(t) whenever
+// the GIL is held; stepWave restores that layout before it returns.
+struct WaveState {
+    Py_ssize_t nx = 0;
+    Py_ssize_t ny = 0;
+    double c = 1.0;
+    double dt = 0.05;
+    double dx = 0.2;
+    double damping = 1.0;  // 0.999 matches the damping in water.cpp
+    long long steps = 0;
+    std::vector<double> buffers[2];
+};
+
+static const int kPrevious = 0;
+static const int kCurrent = 1;
+
+// Number of cell updates between GIL re-acquisitions in Engine_step. Large
+// enough to keep the overhead negligible, small enough that Ctrl-C in a
+// notebook takes effect within a fraction of a second on a 2048^2 grid.
+static const long long kCellsPerChunk = 1LL << 24;
+
+static void stepWave(WaveState& s, long long count) {
+    const Py_ssize_t nx = s.nx;
+    const Py_ssize_t ny = s.ny;
+    const double r2 = (s.c * s.dt / s.dx) * (s.c * s.dt / s.dx);
+    const double damping = s.damping;
+    double* prev = s.buffers[kPrevious].data();
+    double* curr = s.buffers[kCurrent].data();
+
+    for (long long n = 0; n < count; n++) {
+        // u(t+dt) at a cell only needs u(t-dt) at that same cell, so it is
+        // written over prev in place and the two pointers then trade roles.
+        #pragma omp parallel for schedule(static) if (nx * ny >= 256 * 256)
+        for (Py_ssize_t i = 1; i < nx - 1; i++) {
+            const double* up = curr + (i - 1) * ny;
+            const double* row = curr + i * ny;
+            const double* down = curr + (i + 1) * ny;
+            double* nextRow = prev + i * ny;
+            for (Py_ssize_t j = 1; j < ny - 1; j++) {
+                double laplacian = up[j] + down[j] + row[j - 1] + row[j + 1] - 4.0 * row[j];
+                nextRow[j] = (2.0 * row[j] - nextRow[j] + r2 * laplacian) * damping;
+            }
+            nextRow[0] = 0.0;
+            nextRow[ny - 1] = 0.0;
+        }
+
+        // Fixed (zero) boundary rows
+        std::memset(prev, 0, ny * sizeof(double));
+        std::memset(prev + (nx - 1) * ny, 0, ny * sizeof(double));
+
+        std::swap(prev, curr);
+        s.steps++;
+    }
+
+    // After an odd number of steps the roles are swapped; move the data back
+    // so views handed to Python keep meaning u(t-dt) and u(t).
+    if (count % 2 != 0) {
+        std::swap_ranges(s.buffers[kPrevious].begin(), s.buffers[kPrevious].end(),
+                         s.buffers[kCurrent].begin());
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Python bindings
+// ---------------------------------------------------------------------------
+
+struct EngineObject {
+    PyObject_HEAD
+    WaveState* state;
+    bool stepping;  // guards against a second thread stepping concurrently
+    Py_ssize_t liveFields;  // re-init is refused while any Field exists
+    unsigned long generation;  // bumped by every successful init
+};
+
+// Exposes one of the engine's buffers through the buffer protocol. Holds a
+// reference to the engine so the memory stays alive as long as any view does.
+// A Field is bound to a role (previous/current), not to a time level, and is
+// only valid for the generation of the engine it was created from.
+struct FieldObject {
+    PyObject_HEAD
+    EngineObject* engine;
+    int bufferIndex;
+    unsigned long generation;
+    Py_ssize_t shape[2];
+    Py_ssize_t strides[2];
+};
+
+static PyTypeObject EngineType;
+static PyTypeObject FieldType;
+
+// Copies a C-contiguous 2D float64 buffer into dst. Returns false with a
+// Python exception set on failure (including running out of memory).
+static bool copyFromBuffer(PyObject* obj, const char* name, Py_ssize_t* nx, Py_ssize_t* ny,
+                           std::vector<double>& dst) {
+    Py_buffer view;
+    if (PyObject_GetBuffer(obj, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) < 0) {
+        return false;
+    }
+    bool ok = false;
+    if (view.ndim != 2 || view.itemsize != sizeof(double) || !view.format ||
+        std::strcmp(view.format, "d") != 0) {
+        PyErr_Format(PyExc_ValueError, "%s must be a 2D float64 array", name);
+    } else if (view.shape[0] < 3 || view.shape[1] < 3) {
+        PyErr_Format(PyExc_ValueError, "%s must be at least 3x3", name);
+    } else if (*nx && (view.shape[0] != *nx || view.shape[1] != *ny)) {
+        PyErr_Format(PyExc_ValueError, "%s must have shape (%zd, %zd)", name, *nx, *ny);
+    } else {
+        *nx = view.shape[0];
+        *ny = view.shape[1];
+        try {
+            dst.assign(static_cast<const double*>(view.buf),
+                       static_cast<const double*>(view.buf) + (*nx) * (*ny));
+            ok = true;
+        } catch (const std::bad_alloc&) {
+            PyErr_NoMemory();
+        }
+    }
+    PyBuffer_Release(&view);
+    return ok;
+}
+
+static bool checkParameter(double value, const char* name) {
+    if (!std::isfinite(value) || value <= 0.0) {
+        PyErr_Format(PyExc_ValueError, "%s must be positive and finite", name);
+        return false;
+    }
+    return true;
+}
+
+static bool checkDamping(double value) {
+    if (!std::isfinite(value) || value < 0.0) {
+        PyErr_SetString(PyExc_ValueError, "damping must be non-negative and finite");
+        return false;
+    }
+    return true;
+}
+
+// The buffers belong to the stepping thread while the GIL is released, so
+// anything that reads or replaces them must check this.
+static bool checkNotStepping(EngineObject* self, const char* action) {
+    if (self->stepping) {
+        PyErr_Format(PyExc_RuntimeError, "cannot %s while the engine is stepping", action);
+        return false;
+    }
+    return true;
+}
+
+// Re-initialising replaces the buffers, so it must not race a step or leave
+// any view (or the Field behind it) pointing at freed memory.
+static bool checkNotReferenced(EngineObject* self) {
+    if (!checkNotStepping(self, "re-initialise")) {
+        return false;
+    }
+    if (self->liveFields > 0) {
+        PyErr_SetString(PyExc_BufferError, "cannot re-initialise an engine with live views");
+        return false;
+    }
+    return true;
+}
+
+static PyObject* makeField(EngineObject* engine, int bufferIndex) {
+    if (engine->state->nx == 0) {
+        PyErr_SetString(PyExc_RuntimeError, "engine is not initialised");
+        return NULL;
+    }
+    FieldObject* field = PyObject_New(FieldObject, &FieldType);
+    if (!field) {
+        return NULL;
+    }
+    Py_INCREF(engine);
+    engine->liveFields++;
+    field->engine = engine;
+    field->bufferIndex = bufferIndex;
+    field->generation = engine->generation;
+
+    // Wrap in a memoryview so Python code gets a familiar object; the
+    // memoryview keeps the field (and therefore the engine) alive.
+    PyObject* memview = PyMemoryView_FromObject(reinterpret_cast<PyObject*>(field));
+    Py_DECREF(field);
+    return memview;
+}
+
+static void Field_dealloc(FieldObject* self) {
+    self->engine->liveFields--;
+    Py_DECREF(self->engine);
+    PyObject_Free(self);
+}
+
+static int Field_getbuffer(FieldObject* self, Py_buffer* view, int flags) {
+    // The data is C-contiguous with nx, ny >= 3, so it can never be Fortran order
+    if ((flags & PyBUF_F_CONTIGUOUS) == PyBUF_F_CONTIGUOUS) {
+        PyErr_SetString(PyExc_BufferError, "engine fields are C-contiguous");
+        view->obj = NULL;
+        return -1;
+    }
+
+    if (self->generation != self->engine->generation) {
+        PyErr_SetString(PyExc_BufferError, "engine was re-initialised; fetch the view again");
+        view->obj = NULL;
+        return -1;
+    }
+
+    // Shape and length always come from the engine's current state
+    const WaveState& s = *self->engine->state;
+    std::vector<double>& data = self->engine->state->buffers[self->bufferIndex];
+    self->shape[0] = s.nx;
+    self->shape[1] = s.ny;
+    self->strides[0] = s.ny * sizeof(double);
+    self->strides[1] = sizeof(double);
+    Py_ssize_t len = s.nx * s.ny * static_cast<Py_ssize_t>(sizeof(double));
+
+    // Fills a plain byte buffer (ndim 1, no shape) and takes a reference to self
+    if (PyBuffer_FillInfo(view, reinterpret_cast<PyObject*>(self), data.data(), len, 0, flags) < 0) {
+        return -1;
+    }
+
+    // Upgrade to a typed 2D view only when the consumer can handle shape
+    if ((flags & PyBUF_ND) == PyBUF_ND) {
+        view->itemsize = sizeof(double);
+        view->format = (flags & PyBUF_FORMAT) ? const_cast<char*>("d") : NULL;
+        view->ndim = 2;
+        view->shape = self->shape;
+        if ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) {
+            view->strides = self->strides;
+        }
+    }
+    return 0;
+}
+
+static PyBufferProcs Field_as_buffer = {
+    reinterpret_cast<getbufferproc>(Field_getbuffer),
+    NULL,
+};
+
+static void Engine_dealloc(EngineObject* self) {
+    delete self->state;
+    Py_TYPE(self)->tp_free(reinterpret_cast<PyObject*>(self));
+}
+
+static PyObject* Engine_new(PyTypeObject* type, PyObject*, PyObject*) {
+    EngineObject* self = reinterpret_cast<EngineObject*>(type->tp_alloc(type, 0));
+    if (!self) {
+        return NULL;
+    }
+    self->state = new (std::nothrow) WaveState();
+    if (!self->state) {
+        Py_DECREF(self);
+        return PyErr_NoMemory();
+    }
+    self->stepping = false;
+    self->liveFields = 0;
+    self->generation = 0;
+    return reinterpret_cast<PyObject*>(self);
+}
+
+static int Engine_init(EngineObject* self, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"u0", "u_prev", "c", "dt", "dx", "damping", NULL};
+    PyObject* u0 = NULL;
+    PyObject* uPrev = Py_None;
+    double c = 1.0, dt = 0.05, dx = 0.2, damping = 1.0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|Odddd", const_cast<char**>(keywords),
+                                     &u0, &uPrev, &c, &dt, &dx, &damping)) {
+        return -1;
+    }
+    if (!checkNotReferenced(self)) {
+        return -1;
+    }
+    if (!checkParameter(c, "c") || !checkParameter(dt, "dt") || !checkParameter(dx, "dx") ||
+        !checkDamping(damping)) {
+        return -1;
+    }
+
+    WaveState& s = *self->state;
+    Py_ssize_t nx = 0, ny = 0;
+    std::vector<double> curr, prev;
+    try {
+        if (!copyFromBuffer(u0, "u0", &nx, &ny, curr)) {
+            return -1;
+        }
+        if (uPrev == Py_None) {
+            // Same start as 2d_Wave.ipynb: u(t-dt) is all zeros
+            prev.assign(nx * ny, 0.0);
+        } else if (!copyFromBuffer(uPrev, "u_prev", &nx, &ny, prev)) {
+            return -1;
+        }
+    } catch (const std::bad_alloc&) {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    // Reading u0/u_prev may have run Python code that started a step or
+    // fetched a view, so check again before touching any state.
+    if (!checkNotReferenced(self)) {
+        return -1;
+    }
+
+    s.nx = nx;
+    s.ny = ny;
+    s.c = c;
+    s.dt = dt;
+    s.dx = dx;
+    s.damping = damping;
+    s.steps = 0;
+    s.buffers[kPrevious].swap(prev);
+    s.buffers[kCurrent].swap(curr);
+    self->generation++;
+    return 0;
+}
+
+static PyObject* Engine_step(EngineObject* self, PyObject* args) {
+    long long count = 1;
+    if (!PyArg_ParseTuple(args, "|L", &count)) {
+        return NULL;
+    }
+    if (count < 0) {
+        PyErr_SetString(PyExc_ValueError, "step count must be non-negative");
+        return NULL;
+    }
+    if (self->state->nx == 0) {
+        PyErr_SetString(PyExc_RuntimeError, "engine is not initialised");
+        return NULL;
+    }
+    if (!checkNotStepping(self, "step")) {
+        return NULL;
+    }
+
+    // Step in chunks so Ctrl-C / kernel interrupts are noticed; an interrupted
+    // run leaves the engine consistent with `steps` counting completed steps.
+    WaveState& s = *self->state;
+    long long chunk = std::max(2LL, (kCellsPerChunk / (s.nx * s.ny)) & ~1LL);
+    bool interrupted = false;
+    self->stepping = true;
+    while (count > 0 && !interrupted) {
+        long long n = std::min(count, chunk);
+        Py_BEGIN_ALLOW_THREADS
+        stepWave(s, n);
+        Py_END_ALLOW_THREADS
+        count -= n;
+        interrupted = PyErr_CheckSignals() < 0;
+    }
+    self->stepping = false;
+    if (interrupted) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject* Engine_get_current(EngineObject* self, void*) {
+    if (!checkNotStepping(self, "read current")) {
+        return NULL;
+    }
+    return makeField(self, kCurrent);
+}
+
+static PyObject* Engine_get_previous(EngineObject* self, void*) {
+    if (!checkNotStepping(self, "read previous")) {
+        return NULL;
+    }
+    return makeField(self, kPrevious);
+}
+
+static PyObject* Engine_get_shape(EngineObject* self, void*) {
+    return Py_BuildValue("(nn)", self->state->nx, self->state->ny);
+}
+
+static PyObject* Engine_get_steps(EngineObject* self, void*) {
+    if (!checkNotStepping(self, "read steps")) {
+        return NULL;
+    }
+    return PyLong_FromLongLong(self->state->steps);
+}
+
+// Getter/setter pair for the double parameters; closure is a ParamInfo.
+struct ParamInfo {
+    const char* name;
+    double WaveState::* member;
+};
+
+static PyObject* Engine_get_param(EngineObject* self, void* closure) {
+    const ParamInfo* param = static_cast<const ParamInfo*>(closure);
+    return PyFloat_FromDouble(self->state->*(param->member));
+}
+
+static int Engine_set_param(EngineObject* self, PyObject* value, void* closure) {
+    if (!value) {
+        PyErr_SetString(PyExc_AttributeError, "cannot delete engine parameters");
+        return -1;
+    }
+    double v = PyFloat_AsDouble(value);
+    if (v == -1.0 && PyErr_Occurred()) {
+        return -1;
+    }
+    if (!checkNotStepping(self, "change parameters")) {
+        return -1;
+    }
+    const ParamInfo* param = static_cast<const ParamInfo*>(closure);
+    bool valid = param->member == &WaveState::damping ? checkDamping(v)
+                                                      : checkParameter(v, param->name);
+    if (!valid) {
+        return -1;
+    }
+    self->state->*(param->member) = v;
+    return 0;
+}
+
+static ParamInfo paramC = {"c", &WaveState::c};
+static ParamInfo paramDt = {"dt", &WaveState::dt};
+static ParamInfo paramDx = {"dx", &WaveState::dx};
+static ParamInfo paramDamping = {"damping", &WaveState::damping};
+
+static PyMethodDef Engine_methods[] = {
+    {"step", reinterpret_cast<PyCFunction>(Engine_step), METH_VARARGS,
+     "step(n=1)\n\nAdvance the simulation n time steps with the GIL released.\n"
+     "Interruptible with Ctrl-C; `steps` then counts the steps actually taken."},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyGetSetDef Engine_getset[] = {
+    {"current", reinterpret_cast<getter>(Engine_get_current), NULL,
+     "Writable view of u(t); it keeps showing u(t) after later steps.\n"
+     "Raises RuntimeError while stepping; views fetched earlier are being written then.", NULL},
+    {"previous", reinterpret_cast<getter>(Engine_get_previous), NULL,
+     "Writable view of u(t-dt); it keeps showing u(t-dt) after later steps.\n"
+     "Raises RuntimeError while stepping; views fetched earlier are being written then.", NULL},
+    {"shape", reinterpret_cast<getter>(Engine_get_shape), NULL, "Grid shape (nx, ny).", NULL},
+    {"steps", reinterpret_cast<getter>(Engine_get_steps), NULL, "Steps taken since init. Raises RuntimeError while stepping.", NULL},
+    {"c", reinterpret_cast<getter>(Engine_get_param), reinterpret_cast<setter>(Engine_set_param),
+     "Wave speed.", &paramC},
+    {"dt", reinterpret_cast<getter>(Engine_get_param), reinterpret_cast<setter>(Engine_set_param),
+     "Time step.", &paramDt},
+    {"dx", reinterpret_cast<getter>(Engine_get_param), reinterpret_cast<setter>(Engine_set_param),
+     "Grid spacing.", &paramDx},
+    {"damping", reinterpret_cast<getter>(Engine_get_param), reinterpret_cast<setter>(Engine_set_param),
+     "Per-step amplitude factor (1.0 = none).", &paramDamping},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+static PyModuleDef waveEngineModule = {
+    PyModuleDef_HEAD_INIT,
+    "wave_engine",
+    "Leapfrog 2D wave equation solver with zero-copy NumPy views.",
+    -1,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+};
+
+PyMODINIT_FUNC PyInit_wave_engine(void) {
+    FieldType.tp_name = "wave_engine.Field";
+    FieldType.tp_basicsize = sizeof(FieldObject);
+    FieldType.tp_dealloc = reinterpret_cast<destructor>(Field_dealloc);
+    FieldType.tp_as_buffer = &Field_as_buffer;
+    FieldType.tp_flags = Py_TPFLAGS_DEFAULT;
+    FieldType.tp_doc = "Buffer over one of the engine's state arrays.";
+    if (PyType_Ready(&FieldType) < 0) {
+        return NULL;
+    }
+
+    EngineType.tp_name = "wave_engine.Engine";
+    EngineType.tp_basicsize = sizeof(EngineObject);
+    EngineType.tp_dealloc = reinterpret_cast<destructor>(Engine_dealloc);
+    EngineType.tp_flags = Py_TPFLAGS_DEFAULT;
+    EngineType.tp_doc =
+        "Engine(u0, u_prev=None, c=1.0, dt=0.05, dx=0.2, damping=1.0)\n\n"
+        "u0 and u_prev are C-contiguous 2D float64 arrays (copied once at init).\n"
+        "u_prev defaults to zeros, as in 2d_Wave.ipynb.\n\n"
+        "current and previous are live views: they keep their addresses across\n"
+        "step(), so np.asarray(engine.current) always shows the latest u(t).\n"
+        "Copy the array to keep a snapshot. Re-initialising raises BufferError\n"
+        "while any such view is alive.";
+    EngineType.tp_methods = Engine_methods;
+    EngineType.tp_getset = Engine_getset;
+    EngineType.tp_new = Engine_new;
+    EngineType.tp_init = reinterpret_cast<initproc>(Engine_init);
+    if (PyType_Ready(&EngineType) < 0) {
+        return NULL;
+    }
+
+    PyObject* module = PyModule_Create(&waveEngineModule);
+    if (!module) {
+        return NULL;
+    }
+    Py_INCREF(&EngineType);
+    if (PyModule_AddObject(module, "Engine", reinterpret_cast<PyObject*>(&EngineType)) < 0) {
+        Py_DECREF(&EngineType);
+        Py_DECREF(module);
+        return NULL;
+    }
+    return module;
+}